@@ -0,0 +1,215 @@
+#include "Workload.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+static const char TRACE_MAGIC[4] = {'B', 'K', 'T', 'R'};
+static const uint32_t TRACE_VERSION = 1;
+// type byte, id and amount
+static const std::streamoff TRACE_RECORD_BYTES = 9;
+
+WorkloadConfig::WorkloadConfig()
+    : seed(1), accounts(1000), operations(100000), skew(0.99), declineRatio(0.05), maxAmount(10000)
+{
+    mix[OP_CREATE] = 5;
+    mix[OP_REMOVE] = 5;
+    mix[OP_DEPOSIT] = 45;
+    mix[OP_WITHDRAW] = 35;
+    mix[OP_LOAN] = 10;
+}
+
+// Parses one `key=value` option; `mix` takes five comma separated weights
+// in create,remove,deposit,withdraw,loan order.
+void WorkloadConfig::set(const std::string& option)
+{
+    std::string::size_type eq = option.find('=');
+    if (eq == std::string::npos)
+        throw std::invalid_argument("Workload option must be key=value: " + option);
+
+    std::string key = option.substr(0, eq);
+    const char *value = option.c_str() + eq + 1;
+
+    if (key == "seed")
+        seed = std::strtoul(value, NULL, 10);
+    else if (key == "accounts")
+        accounts = std::atoi(value);
+    else if (key == "ops")
+        operations = std::atol(value);
+    else if (key == "skew")
+        skew = std::atof(value);
+    else if (key == "decline")
+        declineRatio = std::atof(value);
+    else if (key == "max")
+        maxAmount = std::atoi(value);
+    else if (key == "mix") {
+        char *end = const_cast<char *>(value);
+        for (int i = 0; i < OP_COUNT; ++i) {
+            mix[i] = static_cast<int>(std::strtol(end, &end, 10));
+            if (*end == ',')
+                ++end;
+        }
+    }
+    else
+        throw std::invalid_argument("Unknown workload option: " + key);
+
+    if (accounts <= 0 || operations < 0 || maxAmount <= 0 || declineRatio < 0 || declineRatio > 1)
+        throw std::invalid_argument("Workload option out of range: " + option);
+}
+
+Workload::Workload(const WorkloadConfig& p_config) : config(p_config), state(p_config.seed)
+{
+    double sum = 0;
+
+    zipfCdf.resize(config.accounts);
+    for (int k = 0; k < config.accounts; ++k) {
+        sum += 1.0 / std::pow(static_cast<double>(k + 1), config.skew);
+        zipfCdf[k] = sum;
+    }
+    for (int k = 0; k < config.accounts; ++k)
+        zipfCdf[k] /= sum;
+}
+
+Workload::~Workload() {}
+
+// splitmix64: tiny, seedable and identical on every platform
+uint64_t Workload::next()
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double Workload::uniform()
+{
+    return static_cast<double>(next() >> 11) / 9007199254740992.0;
+}
+
+int Workload::pickAccount()
+{
+    std::vector<double>::iterator it = std::lower_bound(zipfCdf.begin(), zipfCdf.end(), uniform());
+    if (it == zipfCdf.end())
+        --it;
+    return static_cast<int>(it - zipfCdf.begin());
+}
+
+unsigned char Workload::pickType()
+{
+    int total = 0;
+    for (int i = 0; i < OP_COUNT; ++i)
+        total += config.mix[i] > 0 ? config.mix[i] : 0;
+    if (total <= 0)
+        return OP_DEPOSIT;
+
+    int roll = static_cast<int>(next() % static_cast<uint64_t>(total));
+    for (int i = 0; i < OP_COUNT; ++i) {
+        if (config.mix[i] <= 0)
+            continue;
+        if (roll < config.mix[i])
+            return static_cast<unsigned char>(i);
+        roll -= config.mix[i];
+    }
+    return OP_DEPOSIT;
+}
+
+void Workload::generate(std::vector<Operation>& ops)
+{
+    Operation op;
+
+    ops.clear();
+    ops.reserve(config.accounts + config.operations);
+    for (int id = 0; id < config.accounts; ++id) {
+        op.type = OP_CREATE;
+        op.id = id;
+        op.amount = 1 + static_cast<int>(next() % config.maxAmount);
+        ops.push_back(op);
+    }
+    for (long i = 0; i < config.operations; ++i) {
+        op.type = pickType();
+        op.id = pickAccount();
+        op.amount = 1 + static_cast<int>(next() % config.maxAmount);
+        if (op.type == OP_LOAN)
+            op.amount = 1 + op.amount / 10;
+        if (uniform() < config.declineRatio) {
+            if (op.type == OP_REMOVE)
+                op.id = config.accounts + op.id;
+            else
+                op.amount = -op.amount;
+        }
+        ops.push_back(op);
+    }
+}
+
+static void put32(std::ofstream& out, uint32_t v)
+{
+    unsigned char b[4] = {
+        static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+        static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24)
+    };
+    out.write(reinterpret_cast<const char *>(b), 4);
+}
+
+static uint32_t get32(std::ifstream& in)
+{
+    unsigned char b[4] = {0, 0, 0, 0};
+    in.read(reinterpret_cast<char *>(b), 4);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+// Trace layout (little endian): "BKTR", u32 version, u32 op count, then one
+// 9-byte record per op: u8 type, i32 id, i32 amount.
+void Workload::save(const std::string& path, const std::vector<Operation>& ops)
+{
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot open trace for writing: " + path);
+
+    out.write(TRACE_MAGIC, 4);
+    put32(out, TRACE_VERSION);
+    put32(out, static_cast<uint32_t>(ops.size()));
+    for (std::vector<Operation>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+        out.put(static_cast<char>(it->type));
+        put32(out, static_cast<uint32_t>(it->id));
+        put32(out, static_cast<uint32_t>(it->amount));
+    }
+    if (!out)
+        throw std::runtime_error("Failed writing trace: " + path);
+}
+
+void Workload::load(const std::string& path, std::vector<Operation>& ops)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open trace for reading: " + path);
+
+    char magic[4];
+    in.read(magic, 4);
+    if (!in || !std::equal(magic, magic + 4, TRACE_MAGIC))
+        throw std::runtime_error("Not a bank trace: " + path);
+    if (get32(in) != TRACE_VERSION)
+        throw std::runtime_error("Unsupported trace version: " + path);
+
+    uint32_t count = get32(in);
+    Operation op;
+
+    // the header count is untrusted: bound it by what the file can hold
+    std::streampos body = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff available = in.tellg() - body;
+    in.seekg(body);
+    if (!in || static_cast<std::streamoff>(count) > available / TRACE_RECORD_BYTES)
+        throw std::runtime_error("Truncated or corrupt trace: " + path);
+
+    ops.clear();
+    ops.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        op.type = static_cast<unsigned char>(in.get());
+        op.id = static_cast<int>(get32(in));
+        op.amount = static_cast<int>(get32(in));
+        if (!in || op.type >= OP_COUNT)
+            throw std::runtime_error("Truncated or corrupt trace: " + path);
+        ops.push_back(op);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+enum OperationType
+{
+    OP_CREATE,
+    OP_REMOVE,
+    OP_DEPOSIT,
+    OP_WITHDRAW,
+    OP_LOAN,
+    OP_COUNT
+};
+
+struct Operation
+{
+    unsigned char type;
+    int id;
+    int amount;
+};
+
+struct WorkloadConfig
+{
+    uint64_t seed;
+    int accounts;
+    long operations;
+    double skew;
+    double declineRatio;
+    int maxAmount;
+    int mix[OP_COUNT];
+
+    WorkloadConfig();
+    void set(const std::string& option);
+};
+
+// Seeded synthetic traffic for Bank: every account is created first, then
+// `operations` ops are drawn from the op mix with Zipf-distributed ids.
+// A `declineRatio` share of them is made invalid on purpose (bad amount or
+// unknown id) so the error paths are exercised as well.
+class Workload
+{
+    public:
+        Workload(const WorkloadConfig& p_config);
+        ~Workload();
+
+        void generate(std::vector<Operation>& ops);
+
+        static void save(const std::string& path, const std::vector<Operation>& ops);
+        static void load(const std::string& path, std::vector<Operation>& ops);
+
+    private:
+        WorkloadConfig config;
+        uint64_t state;
+        std::vector<double> zipfCdf;
+
+        uint64_t next();
+        double uniform();
+        int pickAccount();
+        unsigned char pickType();
+};
+
+#endif /* WORKLOAD_HPP */
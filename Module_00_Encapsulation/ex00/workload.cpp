@@ -0,0 +1,125 @@
+#include "Bank/Bank.hpp"
+#include "Workload/Workload.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <streambuf>
+
+// Swallows Bank's per-operation logging while a workload is being driven.
+class NullBuffer : public std::streambuf
+{
+	protected:
+		int overflow(int c) { return c; }
+};
+
+static void usage()
+{
+	std::cerr << "usage: ./workload run    [key=value ...]" << std::endl
+	          << "       ./workload record <trace> [key=value ...]" << std::endl
+	          << "       ./workload replay <trace> [liquidity=N]" << std::endl
+	          << "options: seed accounts ops skew decline max mix=c,r,d,w,l liquidity" << std::endl;
+}
+
+static bool apply(Bank& bank, const Operation& op)
+{
+	try {
+		switch (op.type) {
+			case OP_CREATE:   bank.createAccount(op.id, op.amount); break;
+			case OP_REMOVE:   bank.removeAccount(op.id); break;
+			case OP_DEPOSIT:  bank.depositToAccount(op.id, op.amount); break;
+			case OP_WITHDRAW: bank.withdrawFromAccount(op.id, op.amount); break;
+			case OP_LOAN:     bank.giveLoan(op.id, op.amount); break;
+		}
+	} catch (const std::exception&) {
+		return false;
+	}
+	return true;
+}
+
+// FNV-1a over the bank's own dump, so two builds can be compared
+// without exposing any internals.
+static uint64_t digest(const Bank& bank)
+{
+	std::ostringstream oss;
+	oss << bank;
+
+	const std::string& dump = oss.str();
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (std::string::size_type i = 0; i < dump.size(); ++i) {
+		hash ^= static_cast<unsigned char>(dump[i]);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static void drive(const std::vector<Operation>& ops, int liquidity)
+{
+	NullBuffer null;
+	std::streambuf *saved = std::cout.rdbuf(&null);
+	long declined = 0;
+	uint64_t hash;
+	int finalLiquidity;
+	std::clock_t start = std::clock();
+	{
+		Bank bank(liquidity);
+		for (std::vector<Operation>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+			if (!apply(bank, *it))
+				++declined;
+		}
+		hash = digest(bank);
+		finalLiquidity = bank.get_liquidity();
+	}
+	double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+	std::cout.rdbuf(saved);
+
+	std::cout << "operations : " << ops.size() << std::endl
+	          << "declined   : " << declined << std::endl
+	          << "seconds    : " << seconds << std::endl
+	          << "ops/sec    : " << (seconds > 0 ? static_cast<long>(ops.size() / seconds) : 0) << std::endl
+	          << "liquidity  : " << finalLiquidity << std::endl
+	          << "state hash : " << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		usage();
+		return (1);
+	}
+
+	std::string mode = argv[1];
+	int first = (mode == "run") ? 2 : 3;
+	if ((mode != "run" && mode != "record" && mode != "replay") || argc < first) {
+		usage();
+		return (1);
+	}
+
+	try {
+		WorkloadConfig config;
+		int liquidity = 100000000;
+		std::vector<Operation> ops;
+
+		for (int i = first; i < argc; ++i) {
+			if (std::strncmp(argv[i], "liquidity=", 10) == 0)
+				liquidity = std::atoi(argv[i] + 10);
+			else
+				config.set(argv[i]);
+		}
+
+		if (mode == "replay")
+			Workload::load(argv[2], ops);
+		else {
+			Workload workload(config);
+			workload.generate(ops);
+			if (mode == "record")
+				Workload::save(argv[2], ops);
+		}
+		drive(ops, liquidity);
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return (1);
+	}
+	return (0);
+}
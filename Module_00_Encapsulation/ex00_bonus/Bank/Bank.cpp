@@ -3,11 +3,11 @@
 #include <sstream>
 #include <algorithm> // for std::find_if
 
-static std::string format_cents(int cents)
+static std::string format_cents(long cents)
 {
-    int abs_cents = cents < 0 ? -cents : cents;
-    int dollars = abs_cents / 100;
-    int rem = abs_cents % 100;
+    long abs_cents = cents < 0 ? -cents : cents;
+    long dollars = abs_cents / 100;
+    long rem = abs_cents % 100;
     std::ostringstream oss;
 
     if (cents < 0)
@@ -16,6 +16,23 @@ static std::string format_cents(int cents)
     return oss.str();
 }
 
+// Same order as the currency indexes in Bank.hpp; a table that does not
+// list exactly Bank::CURRENCY_COUNT entries fails to compile.
+static const char *CURRENCY_CODES[] = {"USD", "EUR", "GBP", "CHF", "MAD"};
+static const long DEFAULT_RATES[] = {1000000, 1080000, 1270000, 1130000, 100000};
+typedef char currency_codes_complete[sizeof(CURRENCY_CODES) / sizeof(*CURRENCY_CODES) == Bank::CURRENCY_COUNT ? 1 : -1];
+typedef char default_rates_complete[sizeof(DEFAULT_RATES) / sizeof(*DEFAULT_RATES) == Bank::CURRENCY_COUNT ? 1 : -1];
+
+// Base currency keeps the "$" form, others print as "12.34 EUR".
+static std::string format_money(long cents, unsigned char currency)
+{
+    if (currency == Bank::BASE_CURRENCY)
+        return format_cents(cents);
+    std::string amount = format_cents(cents);
+    amount.erase(amount.find('$'), 1);
+    return amount + " " + CURRENCY_CODES[currency];
+}
+
 // Functor for finding account by ID
 struct Bank::AccountIDMatch
 {
@@ -24,13 +41,23 @@ struct Bank::AccountIDMatch
     bool operator()(Account* acc) const { return acc->get_id() == id; }
 };
 
-Bank::Bank() : liquidity(1000)
+Bank::Bank() : liquidity(1000), tick(0), activeRates(0), coldAfter(0), nextSweep(0),
+      loanBurst(0), loanRefillOps(0)
 {
+    std::fill(pendingFees, pendingFees + SPLIT_STRIPES, Stripe());
+    std::fill(loanBudgets, loanBudgets + SPLIT_STRIPES, Stripe());
+    std::copy(DEFAULT_RATES, DEFAULT_RATES + CURRENCY_COUNT, rateTables[0]);
+    std::copy(DEFAULT_RATES, DEFAULT_RATES + CURRENCY_COUNT, rateTables[1]);
     std::cout << "Bank created with liquidity : " << format_cents(liquidity) << std::endl;
 }
 
-Bank::Bank(int p_liquidity) : liquidity(p_liquidity)
+Bank::Bank(int p_liquidity) : liquidity(p_liquidity), tick(0), activeRates(0), coldAfter(0), nextSweep(0),
+      loanBurst(0), loanRefillOps(0)
 {
+    std::fill(pendingFees, pendingFees + SPLIT_STRIPES, Stripe());
+    std::fill(loanBudgets, loanBudgets + SPLIT_STRIPES, Stripe());
+    std::copy(DEFAULT_RATES, DEFAULT_RATES + CURRENCY_COUNT, rateTables[0]);
+    std::copy(DEFAULT_RATES, DEFAULT_RATES + CURRENCY_COUNT, rateTables[1]);
     std::cout << "Bank created with liquidity : " << format_cents(liquidity) << std::endl;
 }
 
@@ -42,28 +69,51 @@ Bank::~Bank()
     std::cout << "Bank destroyed" << std::endl;
 }
 
-Bank::Account::Account(int p_id, int p_value) : id(p_id), value(p_value)
+Bank::Account::Account(int p_id, int p_value, unsigned char p_currency, bool p_announce)
+    : id(p_id), borrowerSlot(-1), pinnedHot(false), currency(p_currency), stripes(NULL), windowStart(0), value(p_value),
+      windowUpdates(0), lastTouched(0), loanTokens(-1), tokensStamp(0)
 {
-    std::cout << "Account created with id : " << id << " and value : " << format_cents(value) << std::endl;
+    if (p_announce)
+        std::cout << "Account created with id : " << id << " and value : " << format_money(value, currency) << std::endl;
 }
 
-Bank::Account::~Account() {}
+Bank::Account::~Account() { delete[] stripes; }
 
 const int&  Bank::Account::get_id() const { return id; }
-const int& Bank::Account::get_value() const { return value; }
+const unsigned char& Bank::Account::get_currency() const { return currency; }
+
+// Sums the sub-balances without folding them, so reading never writes.
+int Bank::Account::get_value() const
+{
+    int total = value;
+    if (stripes) {
+        for (int i = 0; i < SPLIT_STRIPES; ++i)
+            total += stripes[i].cents;
+    }
+    return total;
+}
 
 std::ostream& operator<<(std::ostream& p_os, const Bank::Account& p_account)
 {
-    p_os << "[" << p_account.get_id() << "] - [" << format_cents(p_account.get_value()) << "]";
+    p_os << "[" << p_account.get_id() << "] - [" << format_money(p_account.get_value(), p_account.get_currency()) << "]";
     return p_os;
 }
 
-const int& Bank::get_liquidity() const { return liquidity; }
+// Sums the pending fees and unused loan budgets into a copy, so reporting
+// never writes.
+int Bank::get_liquidity() const
+{
+    int total = liquidity;
+    for (int i = 0; i < SPLIT_STRIPES; ++i)
+        total += pendingFees[i].cents + loanBudgets[i].cents;
+    return total;
+}
 void Bank::set_clientAccount(Account* p_account) { clientAccounts.push_back(p_account); }
 
 // Refactored findAccountByID using operator[]
 Bank::Account* Bank::findAccountByID(int id)
 {
+    maybeSweep();
     try {
         return &((*this)[id]);
     } catch (const std::exception&) {
@@ -74,7 +124,161 @@ Bank::Account* Bank::findAccountByID(int id)
 int Bank::computeDepositFee(int amount) { return amount * 5 / 100; }
 bool Bank::isAmountValid(int amount) { return amount > 0; }
 
+#if defined(__GNUC__)
+# define BANK_THREAD_LOCAL __thread
+#else
+# define BANK_THREAD_LOCAL
+#endif
+
+static unsigned int lanesHandedOut = 0;
+
+// Lane of the calling thread: handed out round-robin the first time the
+// thread writes a stripe and kept for its lifetime, so concurrent writers
+// stay on different lines without sharing a per-deposit counter.
+unsigned int Bank::threadLane()
+{
+    static BANK_THREAD_LOCAL unsigned int lane = 0;
+
+    if (lane == 0) {
+#if defined(__GNUC__)
+        lane = __sync_add_and_fetch(&lanesHandedOut, 1);
+#else
+        lane = ++lanesHandedOut;
+#endif
+    }
+    return (lane - 1) % SPLIT_STRIPES;
+}
+
+void Bank::collectFee(int fee) { pendingFees[threadLane()].cents += fee; }
+
+// Moves every lane's pending fees and unused loan budget into liquidity.
+void Bank::foldFees()
+{
+    for (int i = 0; i < SPLIT_STRIPES; ++i) {
+        liquidity += pendingFees[i].cents + loanBudgets[i].cents;
+        pendingFees[i].cents = 0;
+        loanBudgets[i].cents = 0;
+    }
+}
+
+// Loans are paid from the calling thread's budget, so approvals on
+// different threads do not all debit the shared liquidity. A short budget
+// takes at least LOAN_CHUNK from liquidity; when liquidity cannot cover the
+// shortfall, fees and every lane's budget are folded back first, so a loan
+// is refused only when the bank as a whole cannot cover it.
+void Bank::reserveLiquidity(int amount)
+{
+    Stripe& budget = loanBudgets[threadLane()];
+
+    if (budget.cents >= amount) {
+        budget.cents -= amount;
+        return;
+    }
+    if (liquidity < amount - budget.cents) {
+        foldFees();
+        if (liquidity < amount)
+            throw std::invalid_argument("The bank has insufficient liquidity");
+    }
+    int chunk = amount - budget.cents;
+    if (chunk < LOAN_CHUNK)
+        chunk = LOAN_CHUNK;
+    if (chunk > liquidity)
+        chunk = liquidity;
+    liquidity -= chunk;
+    budget.cents += chunk - amount;
+}
+
+// Token bucket per account on the bank's operation clock: up to loanBurst
+// loans at once, one more every loanRefillOps operations.
+bool Bank::hasLoanToken(Account* account)
+{
+    if (loanBurst <= 0)
+        return true;
+    if (account->loanTokens < 0) {
+        account->loanTokens = loanBurst;
+        account->tokensStamp = tick;
+    }
+    // tokens earned under a larger burst do not survive lowering it
+    if (account->loanTokens > loanBurst)
+        account->loanTokens = loanBurst;
+    unsigned long refills = (tick - account->tokensStamp) / loanRefillOps;
+    if (refills > 0) {
+        account->loanTokens = static_cast<int>(std::min<unsigned long>(loanBurst, account->loanTokens + refills));
+        account->tokensStamp += refills * loanRefillOps;
+    }
+    return account->loanTokens > 0;
+}
+
+// Counts deposits per HOT_WINDOW bank operations: an account crossing
+// HOT_THRESHOLD is split, and a split account that cools off to less than
+// half of it is merged back unless it was designated hot. A split account
+// counts in its lane's stripe, so depositors only read the shared line.
+void Bank::trackUpdate(Account* account, unsigned int lane)
+{
+    if (tick - account->windowStart >= HOT_WINDOW)
+        rollWindow(account);
+    if (account->stripes)
+        ++account->stripes[lane].updates;
+    else if (++account->windowUpdates >= HOT_THRESHOLD)
+        promote(account);
+}
+
+// Once per window: sums the lane counts, then decides on demotion.
+void Bank::rollWindow(Account* account)
+{
+    int updates = account->windowUpdates;
+
+    if (account->stripes) {
+        for (int i = 0; i < SPLIT_STRIPES; ++i) {
+            updates += account->stripes[i].updates;
+            account->stripes[i].updates = 0;
+        }
+        if (!account->pinnedHot && updates < HOT_THRESHOLD / 2)
+            demote(account);
+    }
+    account->windowStart = tick;
+    account->windowUpdates = 0;
+}
+
+void Bank::promote(Account* account)
+{
+    account->stripes = new Stripe[SPLIT_STRIPES]();
+}
+
+void Bank::demote(Account* account)
+{
+    account->value = account->get_value();
+    delete[] account->stripes;
+    account->stripes = NULL;
+    account->lastTouched = tick;
+}
+
+void Bank::designateHotAccount(int id, bool hot)
+{
+    Account* account = findAccountByID(id);
+    if (!account)
+        throw std::invalid_argument("Account with ID not found");
+
+    account->pinnedHot = hot;
+    if (hot && !account->stripes)
+        promote(account);
+    else if (!hot && account->stripes)
+        demote(account);
+}
+
 void Bank::createAccount(int id, int amount)
+{
+    openAccount(id, amount, BASE_CURRENCY);
+}
+
+void Bank::createAccount(int id, int amount, const std::string& currency)
+{
+    openAccount(id, amount, currencyIndex(currency));
+}
+
+// The 5% fee is taken in the account's currency and converted into
+// liquidity, which is always kept in the base currency.
+void Bank::openAccount(int id, int amount, unsigned char currency)
 {
     if (!isAmountValid(amount))
         throw std::invalid_argument("The initial amount must be positive");
@@ -83,18 +287,31 @@ void Bank::createAccount(int id, int amount)
         throw std::invalid_argument("Account with ID already exists");
 
     int fee = computeDepositFee(amount);
-    liquidity += fee;
+    collectFee(static_cast<int>(toBase(fee, currency)));
 
-    Account* account = new Account(id, amount - fee);
+    Account* account = new Account(id, amount - fee, currency);
+    account->lastTouched = tick;
     set_clientAccount(account);
 }
 
+bool Bank::owesLoans(const Account* account) const
+{
+    return account->borrowerSlot >= 0 && loans.get_exposure(account->borrowerSlot) > 0;
+}
+
 void Bank::removeAccount(int id)
 {
     Account* account = findAccountByID(id);
     if (!account)
         throw std::invalid_argument("Account with ID not found");
 
+    if (account->borrowerSlot >= 0) {
+        if (owesLoans(account))
+            throw std::invalid_argument("Account has outstanding loans");
+        borrowers[account->borrowerSlot] = NULL;
+        loans.releaseBorrower(account->borrowerSlot);
+    }
+
     std::vector<Account*>::iterator it = std::find(clientAccounts.begin(), clientAccounts.end(), account);
     if (it != clientAccounts.end())
     {
@@ -115,12 +332,19 @@ void Bank::depositToAccount(int id, int amount)
 
     int fee = computeDepositFee(amount);
     int netDeposit = amount - fee;
-    liquidity += fee;
+    int balance = account->get_value();
+    collectFee(static_cast<int>(toBase(fee, account->currency)));
     std::cout << "Balance of account with id : " << account->id << " increased from " 
-              << format_cents(account->value) << " to " << format_cents(account->value + netDeposit) << std::endl;
-    account->value += netDeposit;
-
-    std::cout << "Deposit of " << format_cents(amount) << " to account with id : " << id << " is successful" << std::endl;
+              << format_money(balance, account->currency) << " to " << format_money(balance + netDeposit, account->currency) << std::endl;
+    ++tick;
+    unsigned int lane = threadLane();
+    trackUpdate(account, lane);
+    if (account->stripes)
+        account->stripes[lane].cents += netDeposit;
+    else
+        account->value += netDeposit;
+
+    std::cout << "Deposit of " << format_money(amount, account->currency) << " to account with id : " << id << " is successful" << std::endl;
 }
 
 void Bank::withdrawFromAccount(int id, int amount)
@@ -132,34 +356,283 @@ void Bank::withdrawFromAccount(int id, int amount)
     if (!account)
         throw std::invalid_argument("Account with ID not found");
 
-    if (account->get_value() < amount)
+    int balance = account->get_value();
+    if (balance < amount)
         throw std::invalid_argument("Account has insufficient balance");
 
+    ++tick;
     std::cout << "Balance of account with id : " << account->id << " decreased from "
-              << format_cents(account->value) << " to " << format_cents(account->value - amount) << std::endl;
+              << format_money(balance, account->currency) << " to " << format_money(balance - amount, account->currency) << std::endl;
     account->value -= amount;
-    std::cout << "Withdrawal of " << format_cents(amount) << " from account with id : " << id << " is successful" << std::endl;
+    std::cout << "Withdrawal of " << format_money(amount, account->currency) << " from account with id : " << id << " is successful" << std::endl;
 }
 
-void Bank::giveLoan(int accountID, int amount)
+void Bank::giveLoan(int accountID, int amount, int rateBps, int terms)
 {
     if (!isAmountValid(amount))
         throw std::invalid_argument("The loan amount must be positive");
 
-    if (liquidity < amount)
-        throw std::invalid_argument("The bank has insufficient liquidity");
+    if (rateBps < 0 || terms <= 0)
+        throw std::invalid_argument("The loan rate and term must be valid");
 
     Account* account = findAccountByID(accountID);
     if (!account)
         throw std::invalid_argument("Account with ID not found");
 
+    if (account->currency != BASE_CURRENCY)
+        throw std::invalid_argument("Loans are only given in the base currency");
+
+    if (!hasLoanToken(account))
+        throw std::invalid_argument("Loan rate limit exceeded for this account");
+
+    reserveLiquidity(amount);
+    if (loanBurst > 0)
+        account->loanTokens--;
+
+    if (account->borrowerSlot < 0) {
+        account->borrowerSlot = static_cast<int>(loans.addBorrower());
+        if (static_cast<std::size_t>(account->borrowerSlot) == borrowers.size())
+            borrowers.push_back(account);
+        else
+            borrowers[account->borrowerSlot] = account;
+    }
+    loans.open(account->borrowerSlot, amount, rateBps, terms);
+
+    ++tick;
     std::cout << "Balance of account with id : " << account->id << " increased from " 
-              << format_cents(account->value) << " to " << format_cents(account->value + amount) << std::endl;
+              << format_cents(account->get_value()) << " to " << format_cents(account->get_value() + amount) << std::endl;
     account->value += amount;
-    liquidity -= amount;
     std::cout << "Loan of " << format_cents(amount) << " to account with id : " << accountID << " is successful" << std::endl;
 }
 
+void Bank::accrueLoanInterest()
+{
+    long interest = loans.accrueInterest();
+    std::cout << "Interest of " << format_cents(interest) << " accrued on "
+              << loans.get_loanCount() << " loans" << std::endl;
+}
+
+// Debits each loan's scheduled installment from its borrower, capped at the
+// borrower's balance; whatever is left unpaid rolls into the next period.
+void Bank::collectLoanInstallments()
+{
+    std::vector<long> due;
+    long collected = 0;
+
+    loans.scheduleInstallments(due);
+    for (std::size_t i = 0; i < due.size(); ++i) {
+        Account* account = borrowers[loans.get_borrower(i)];
+        long balance = account->get_value();
+        long paid = due[i] < balance ? due[i] : balance;
+        account->value -= static_cast<int>(paid);
+        liquidity += static_cast<int>(paid);
+        loans.applyRepayment(i, paid);
+        collected += paid;
+    }
+    loans.settle();
+    std::cout << "Installments of " << format_cents(collected) << " collected, "
+              << loans.get_loanCount() << " loans still open" << std::endl;
+}
+
+// A query: the account is looked up without sweeping or re-hydrating it.
+// Indebted accounts are never tiered cold, so a cold account owes nothing.
+long Bank::get_exposure(int accountID) const
+{
+    std::vector<Account*>::const_iterator it = std::find_if(
+        clientAccounts.begin(),
+        clientAccounts.end(),
+        AccountIDMatch(accountID)
+    );
+    int value;
+
+    if (it == clientAccounts.end()) {
+        if (coldAccounts.find(accountID, value))
+            return 0;
+        throw std::invalid_argument("Account with ID not found");
+    }
+    if ((*it)->borrowerSlot < 0)
+        return 0;
+    return loans.get_exposure((*it)->borrowerSlot);
+}
+
+const long& Bank::get_outstandingLoans() const { return loans.get_outstanding(); }
+
+void Bank::set_loanRateLimit(int burst, unsigned long refillOps)
+{
+    if (burst < 0 || (burst > 0 && refillOps == 0))
+        throw std::invalid_argument("The loan rate limit must be valid");
+    loanBurst = burst;
+    loanRefillOps = refillOps;
+}
+
+void Bank::set_coldAfter(unsigned long operations)
+{
+    coldAfter = operations;
+    nextSweep = tick + operations;
+}
+
+void Bank::maybeSweep()
+{
+    if (coldAfter != 0 && tick >= nextSweep)
+        sweepColdAccounts();
+}
+
+// Moves every account idle for coldAfter operations into the cold store.
+// Split, pinned and indebted accounts stay resident since other
+// structures hold pointers to them; a repaid borrower gives its slot back
+// on the way out. The cold store only keeps base currency balances.
+void Bank::sweepColdAccounts()
+{
+    std::vector<Account*> resident;
+    std::vector<std::pair<int, int> > swept;
+
+    resident.reserve(clientAccounts.size());
+    for (std::vector<Account*>::iterator it = clientAccounts.begin(); it != clientAccounts.end(); ++it) {
+        Account* account = *it;
+        if (account->stripes || account->pinnedHot || owesLoans(account)
+            || account->currency != BASE_CURRENCY || tick - account->lastTouched < coldAfter)
+            resident.push_back(account);
+        else {
+            if (account->borrowerSlot >= 0) {
+                borrowers[account->borrowerSlot] = NULL;
+                loans.releaseBorrower(account->borrowerSlot);
+            }
+            swept.push_back(std::make_pair(account->id, account->value));
+            delete account;
+        }
+    }
+    coldAccounts.putAll(swept);
+    // exact-sized copy, so the vector does not keep a slot per swept account
+    std::vector<Account*>(resident.begin(), resident.end()).swap(clientAccounts);
+    nextSweep = tick + coldAfter;
+}
+
+const std::size_t& Bank::get_coldAccountCount() const { return coldAccounts.get_count(); }
+
+unsigned char Bank::currencyIndex(const std::string& code)
+{
+    for (int i = 0; i < CURRENCY_COUNT; ++i) {
+        if (code == CURRENCY_CODES[i])
+            return static_cast<unsigned char>(i);
+    }
+    throw std::invalid_argument("Unknown currency: " + code);
+}
+
+// Fixed-point conversion, split so amount * rate cannot overflow.
+long Bank::toBase(long amount, unsigned char currency) const
+{
+    long rate = rateTables[activeRates][currency];
+    return (amount / RATE_SCALE) * rate + (amount % RATE_SCALE) * rate / RATE_SCALE;
+}
+
+// The new table is built and validated in the idle slot, then published
+// by switching activeRates, so a bad table is rejected as a unit and
+// conversions always read one whole table. The bank is single threaded;
+// a concurrent build would also need that switch to be a release store.
+void Bank::swapRates(const std::map<std::string, long>& microRates)
+{
+    long *next = rateTables[activeRates ^ 1];
+
+    std::copy(rateTables[activeRates], rateTables[activeRates] + CURRENCY_COUNT, next);
+    for (std::map<std::string, long>::const_iterator it = microRates.begin(); it != microRates.end(); ++it) {
+        unsigned char currency = currencyIndex(it->first);
+        if (it->second <= 0)
+            throw std::invalid_argument("Exchange rates must be positive");
+        if (currency == BASE_CURRENCY && it->second != RATE_SCALE)
+            throw std::invalid_argument("The base currency rate is fixed");
+        next[currency] = it->second;
+    }
+    activeRates ^= 1;
+}
+
+// One pass that only adds balances into per-currency totals; conversion
+// then happens once per currency instead of once per account.
+void Bank::sumByCurrency(long totals[CURRENCY_COUNT]) const
+{
+    std::fill(totals, totals + CURRENCY_COUNT, 0L);
+    for (std::vector<Account*>::const_iterator it = clientAccounts.begin(); it != clientAccounts.end(); ++it)
+        totals[(*it)->currency] += (*it)->get_value();
+    totals[BASE_CURRENCY] += coldAccounts.get_total();
+}
+
+long Bank::consolidatedTotal() const
+{
+    long totals[CURRENCY_COUNT];
+    long consolidated = 0;
+
+    sumByCurrency(totals);
+    for (int i = 0; i < CURRENCY_COUNT; ++i)
+        consolidated += toBase(totals[i], static_cast<unsigned char>(i));
+    return consolidated;
+}
+
+void Bank::printConsolidation(std::ostream& os) const
+{
+    long totals[CURRENCY_COUNT];
+    long consolidated = 0;
+
+    sumByCurrency(totals);
+    os << "Consolidated balances : " << std::endl;
+    for (int i = 0; i < CURRENCY_COUNT; ++i) {
+        if (totals[i] == 0)
+            continue;
+        long converted = toBase(totals[i], static_cast<unsigned char>(i));
+        os << CURRENCY_CODES[i] << " : " << format_money(totals[i], static_cast<unsigned char>(i));
+        if (i != BASE_CURRENCY)
+            os << " -> " << format_cents(converted);
+        os << std::endl;
+        consolidated += converted;
+    }
+    os << "Total : " << format_cents(consolidated) << std::endl;
+}
+
+// Applies the operation unless requestKey was already seen: a key that
+// succeeded is a no-op, one that failed throws the original error again,
+// and one whose outcome the cache no longer holds is refused.
+void Bank::runOnce(uint64_t requestKey, void (Bank::*operation)(int, int), int id, int amount)
+{
+    std::time_t now = std::time(NULL);
+    std::string error;
+
+    switch (requests.check(requestKey, now, error)) {
+        case IdempotencyCache::APPLIED:
+            std::cout << "Request " << requestKey << " was already applied" << std::endl;
+            return;
+        case IdempotencyCache::FAILED:
+            throw std::invalid_argument(error);
+        case IdempotencyCache::UNKNOWN:
+            throw std::invalid_argument("Request key already seen, original result unknown");
+        case IdempotencyCache::NEW:
+            break;
+    }
+
+    try {
+        (this->*operation)(id, amount);
+    } catch (const std::exception& e) {
+        requests.record(requestKey, now, e.what());
+        throw;
+    }
+    requests.record(requestKey, now, NULL);
+}
+
+void Bank::createAccount(int id, int amount, uint64_t requestKey)
+{
+    void (Bank::*operation)(int, int) = &Bank::createAccount;
+    runOnce(requestKey, operation, id, amount);
+}
+
+void Bank::depositToAccount(int id, int amount, uint64_t requestKey)
+{
+    void (Bank::*operation)(int, int) = &Bank::depositToAccount;
+    runOnce(requestKey, operation, id, amount);
+}
+
+void Bank::withdrawFromAccount(int id, int amount, uint64_t requestKey)
+{
+    void (Bank::*operation)(int, int) = &Bank::withdrawFromAccount;
+    runOnce(requestKey, operation, id, amount);
+}
+
 void Bank::printAccount(int id, std::ostream& os) const
 {
     for (std::vector<Account*>::const_iterator it = clientAccounts.begin(); it != clientAccounts.end(); ++it) {
@@ -168,6 +641,11 @@ void Bank::printAccount(int id, std::ostream& os) const
             return;
         }
     }
+    int value;
+    if (coldAccounts.find(id, value)) {
+        os << "[" << id << "] - [" << format_cents(value) << "]";
+        return;
+    }
     throw std::invalid_argument("Account with ID not found");
 }
 
@@ -179,8 +657,21 @@ Bank::Account& Bank::operator[](int id)
         AccountIDMatch(id)
     );
 
-    if (it != clientAccounts.end())
+    // split accounts are never swept, so their shared line is left alone
+    if (it != clientAccounts.end()) {
+        if (!(*it)->stripes)
+            (*it)->lastTouched = tick;
         return **it;
+    }
+
+    // transparently re-hydrate a dormant account
+    int value;
+    if (coldAccounts.take(id, value)) {
+        Account* account = new Account(id, value, BASE_CURRENCY, false);
+        account->lastTouched = tick;
+        set_clientAccount(account);
+        return *account;
+    }
 
     throw std::invalid_argument("Account with ID not found");
 }
@@ -189,8 +680,14 @@ std::ostream& operator<<(std::ostream& p_os, const Bank& p_bank)
 {
     p_os << "Bank informations : " << std::endl;
     p_os << "Liquidity : " << format_cents(p_bank.get_liquidity()) << std::endl;
+    p_os << "Outstanding loans : " << format_cents(p_bank.get_outstandingLoans()) << std::endl;
     const std::vector<Bank::Account*>& accounts = p_bank.clientAccounts;
     for (std::vector<Bank::Account*>::const_iterator it = accounts.begin(); it != accounts.end(); ++it)
         p_os << **it << std::endl;
+
+    std::vector<std::pair<int, int> > cold;
+    p_bank.coldAccounts.entries(cold);
+    for (std::vector<std::pair<int, int> >::const_iterator it = cold.begin(); it != cold.end(); ++it)
+        p_os << "[" << it->first << "] - [" << format_cents(it->second) << "]" << std::endl;
     return p_os;
 }
@@ -3,33 +3,125 @@
 
 #include <iostream>
 #include <vector>
+#include <map>
+#include <string>
 #include <algorithm> 
 #include <iterator>
 
+#include "../LoanBook/LoanBook.hpp"
+#include "../IdempotencyCache/IdempotencyCache.hpp"
+#include "../ColdStore/ColdStore.hpp"
+
+// Every stripe fills a whole cache line. Built with -DBANK_PADDED_LAYOUT
+// (make LAYOUT=padded), a full line of padding also keeps write-hot fields
+// off the lines of their neighbours. Padding rather than alignment, since
+// C++98 operator new cannot honour over-aligned types.
+#ifndef BANK_CACHE_LINE
+# define BANK_CACHE_LINE 64
+#endif
+#ifdef BANK_PADDED_LAYOUT
+# define BANK_LINE_PAD(name) char name[BANK_CACHE_LINE];
+#else
+# define BANK_LINE_PAD(name)
+#endif
+
 class Bank
 {
+    public:
+        // index 0 is the base currency (USD) in which liquidity is kept
+        static const int CURRENCY_COUNT = 5;
+        static const int BASE_CURRENCY = 0;
+
     private:
 
+        // one lane's share of a split account: its deposits and how many
+        // of them landed in the current hot window
+        struct Stripe
+        {
+            int cents;
+            int updates;
+            char pad[BANK_CACHE_LINE - 2 * sizeof(int)];
+        };
+
         class Account
         {
             public:
             
             const int& get_id() const;
-            const int& get_value() const;
+            int get_value() const;
+            const unsigned char& get_currency() const;
 
             private:
-                Account(int p_id, int p_value);
+                Account(int p_id, int p_value, unsigned char p_currency = 0, bool p_announce = true);
                 ~Account();
                 
+                // read-mostly; windowStart changes once per hot window
                 int id;
+                int borrowerSlot;
+                bool pinnedHot;
+                unsigned char currency;
+                Stripe *stripes;
+                unsigned long windowStart;
+
+                // the balance: written by withdrawals, loans and deposits
+                // into an unsplit account; a split account's deposits land
+                // in one of SPLIT_STRIPES sub-balances, summed on read
+                BANK_LINE_PAD(coldPad)
                 int value;
+                BANK_LINE_PAD(valuePad)
+
+                // bookkeeping of unsplit accounts and of loans
+                int windowUpdates;
+                unsigned long lastTouched;
+                int loanTokens;
+                unsigned long tokensStamp;
+                BANK_LINE_PAD(hotPad)
                 
                 friend class Bank;
         };
         
+        static const int SPLIT_STRIPES = 8;
+        static const unsigned long HOT_WINDOW = 1024;
+        static const int HOT_THRESHOLD = 64;
+
+        // rates are base micro-units per unit of each currency
+        static const long RATE_SCALE = 1000000;
+
+        // smallest share of liquidity a thread's loan budget takes at once
+        static const int LOAN_CHUNK = 10000;
+
         int liquidity;
         std::vector<Account *> clientAccounts;
         struct AccountIDMatch;
+
+        LoanBook loans;
+        std::vector<Account *> borrowers;
+
+        unsigned long tick;
+
+        // fees are collected per lane, summed with liquidity on read and
+        // folded into it before liquidity is debited
+        BANK_LINE_PAD(feePad)
+        Stripe pendingFees[SPLIT_STRIPES];
+
+        // liquidity reserved per thread lane for loans, see reserveLiquidity()
+        Stripe loanBudgets[SPLIT_STRIPES];
+
+        IdempotencyCache requests;
+
+        // two whole tables; swapRates() fills the idle one, then flips
+        // activeRates so a table is never seen half written
+        long rateTables[2][CURRENCY_COUNT];
+        int activeRates;
+
+        // dormant accounts, see sweepColdAccounts()
+        ColdStore coldAccounts;
+        unsigned long coldAfter;
+        unsigned long nextSweep;
+
+        // per-account loan token bucket, see set_loanRateLimit()
+        int loanBurst;
+        unsigned long loanRefillOps;
         
         void set_clientAccount(Account *p_account);
         
@@ -39,6 +131,22 @@ class Bank
         Account *findAccountByID(int id);
         int computeDepositFee(int amount);
         bool isAmountValid(int amount);
+        static unsigned int threadLane();
+        void collectFee(int fee);
+        void foldFees();
+        void reserveLiquidity(int amount);
+        bool hasLoanToken(Account* account);
+        bool owesLoans(const Account* account) const;
+        void maybeSweep();
+        void openAccount(int id, int amount, unsigned char currency);
+        static unsigned char currencyIndex(const std::string& code);
+        long toBase(long amount, unsigned char currency) const;
+        void sumByCurrency(long totals[CURRENCY_COUNT]) const;
+        void runOnce(uint64_t requestKey, void (Bank::*operation)(int, int), int id, int amount);
+        void trackUpdate(Account* account, unsigned int lane);
+        void rollWindow(Account* account);
+        void promote(Account* account);
+        void demote(Account* account);
         
         
         friend std::ostream& operator << (std::ostream& p_os, const Account& p_account);
@@ -49,16 +157,38 @@ class Bank
 
         ~Bank();
 
-        const int& get_liquidity() const;
+        int get_liquidity() const;
 
         //bank operations
         void createAccount(int id, int amount);
         void removeAccount(int id);
         void depositToAccount(int id, int amount);
         void withdrawFromAccount(int id, int amount);
+        void designateHotAccount(int id, bool hot);
+
+        //cold tiering: 0 (default) keeps every account resident
+        void set_coldAfter(unsigned long operations);
+        void sweepColdAccounts();
+        const std::size_t& get_coldAccountCount() const;
+
+        //currencies: USD (base), EUR, GBP, CHF, MAD
+        void createAccount(int id, int amount, const std::string& currency);
+        void swapRates(const std::map<std::string, long>& microRates);
+        long consolidatedTotal() const;
+        void printConsolidation(std::ostream& os) const;
+
+        //idempotent variants: a retried key returns the original result
+        void createAccount(int id, int amount, uint64_t requestKey);
+        void depositToAccount(int id, int amount, uint64_t requestKey);
+        void withdrawFromAccount(int id, int amount, uint64_t requestKey);
         
-        //loan operation
-        void giveLoan(int accountID, int amount);
+        //loan operations
+        void giveLoan(int accountID, int amount, int rateBps = 0, int terms = 1);
+        void accrueLoanInterest();
+        void collectLoanInstallments();
+        long get_exposure(int accountID) const;
+        const long& get_outstandingLoans() const;
+        void set_loanRateLimit(int burst, unsigned long refillOps);
         
         void printAccount(int id, std::ostream& os) const;
         friend std::ostream& operator << (std::ostream& p_os, const Bank& p_bank);
@@ -0,0 +1,157 @@
+#include "ColdStore.hpp"
+#include <algorithm>
+#include <limits>
+
+static void putVarint(std::vector<unsigned char>& out, unsigned int v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+static unsigned int getVarint(const unsigned char *&p)
+{
+    unsigned int v = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        v |= static_cast<unsigned int>(*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return v | (static_cast<unsigned int>(*p++) << shift);
+}
+
+static unsigned int zigzag(int v)
+{
+    return (static_cast<unsigned int>(v) << 1) ^ static_cast<unsigned int>(v >> 31);
+}
+
+static int unzigzag(unsigned int v)
+{
+    return static_cast<int>(v >> 1) ^ -static_cast<int>(v & 1);
+}
+
+ColdStore::ColdStore() : count(0), total(0) {}
+
+ColdStore::~ColdStore() {}
+
+void ColdStore::decode(int key, const Block& block, Entries& out)
+{
+    const unsigned char *p = block.empty() ? NULL : &block[0];
+    const unsigned char *end = p + block.size();
+    unsigned int id = static_cast<unsigned int>(key) << BLOCK_BITS;
+
+    out.clear();
+    while (p < end) {
+        id += getVarint(p);
+        out.push_back(std::make_pair(static_cast<int>(id), unzigzag(getVarint(p))));
+    }
+}
+
+// Re-encodes a block into an exactly sized buffer; an empty one is dropped.
+void ColdStore::store(int key, const Entries& in)
+{
+    std::map<int, Block>::iterator it = blocks.find(key);
+    if (in.empty()) {
+        if (it != blocks.end())
+            blocks.erase(it);
+        return;
+    }
+
+    Block encoded;
+    unsigned int prev = static_cast<unsigned int>(key) << BLOCK_BITS;
+    for (Entries::const_iterator e = in.begin(); e != in.end(); ++e) {
+        putVarint(encoded, static_cast<unsigned int>(e->first) - prev);
+        putVarint(encoded, zigzag(e->second));
+        prev = static_cast<unsigned int>(e->first);
+    }
+    Block(encoded).swap(blocks[key]);
+}
+
+// Bulk put for sweeps: accounts are sorted by id so each block they land
+// in is decoded and re-encoded once, not once per account.
+void ColdStore::putAll(std::vector<std::pair<int, int> >& accounts)
+{
+    Entries existing;
+    Entries merged;
+
+    std::sort(accounts.begin(), accounts.end());
+    std::vector<std::pair<int, int> >::const_iterator it = accounts.begin();
+    while (it != accounts.end()) {
+        int key = it->first >> BLOCK_BITS;
+        std::map<int, Block>::const_iterator block = blocks.find(key);
+
+        if (block != blocks.end())
+            decode(key, block->second, existing);
+        else
+            existing.clear();
+
+        merged.clear();
+        Entries::const_iterator old = existing.begin();
+        for (; it != accounts.end() && (it->first >> BLOCK_BITS) == key; ++it) {
+            while (old != existing.end() && old->first < it->first)
+                merged.push_back(*old++);
+            if (old != existing.end() && old->first == it->first)
+                total -= (old++)->second;
+            else
+                ++count;
+            merged.push_back(*it);
+            total += it->second;
+        }
+        merged.insert(merged.end(), old, Entries::const_iterator(existing.end()));
+        store(key, merged);
+    }
+}
+
+bool ColdStore::take(int id, int& value)
+{
+    int key = id >> BLOCK_BITS;
+    std::map<int, Block>::const_iterator it = blocks.find(key);
+    if (it == blocks.end())
+        return false;
+
+    Entries entries;
+    decode(key, it->second, entries);
+    Entries::iterator pos = std::lower_bound(entries.begin(), entries.end(), std::make_pair(id, std::numeric_limits<int>::min()));
+    if (pos == entries.end() || pos->first != id)
+        return false;
+
+    value = pos->second;
+    entries.erase(pos);
+    total -= value;
+    --count;
+    store(key, entries);
+    return true;
+}
+
+bool ColdStore::find(int id, int& value) const
+{
+    int key = id >> BLOCK_BITS;
+    std::map<int, Block>::const_iterator it = blocks.find(key);
+    if (it == blocks.end())
+        return false;
+
+    Entries entries;
+    decode(key, it->second, entries);
+    Entries::const_iterator pos = std::lower_bound(entries.begin(), entries.end(), std::make_pair(id, std::numeric_limits<int>::min()));
+    if (pos == entries.end() || pos->first != id)
+        return false;
+    value = pos->second;
+    return true;
+}
+
+void ColdStore::entries(std::vector<std::pair<int, int> >& out) const
+{
+    Entries block;
+
+    out.clear();
+    out.reserve(count);
+    for (std::map<int, Block>::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+        decode(it->first, it->second, block);
+        out.insert(out.end(), block.begin(), block.end());
+    }
+}
+
+const std::size_t& ColdStore::get_count() const { return count; }
+const long& ColdStore::get_total() const { return total; }
@@ -0,0 +1,41 @@
+#ifndef COLDSTORE_HPP
+#define COLDSTORE_HPP
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+// Compressed home of dormant accounts. Ids are grouped in blocks of
+// BLOCK_SPAN consecutive ids; each block is a byte string of
+// (id delta, zigzag value) varint pairs sorted by id, so a dense run of
+// small balances costs a few bytes per account.
+class ColdStore
+{
+    public:
+        static const int BLOCK_BITS = 8;
+
+        ColdStore();
+        ~ColdStore();
+
+        void putAll(std::vector<std::pair<int, int> >& accounts);
+        bool take(int id, int& value);
+        bool find(int id, int& value) const;
+        void entries(std::vector<std::pair<int, int> >& out) const;
+
+        const std::size_t& get_count() const;
+        const long& get_total() const;
+
+    private:
+        typedef std::vector<unsigned char> Block;
+        typedef std::vector<std::pair<int, int> > Entries;
+
+        std::map<int, Block> blocks;
+        std::size_t count;
+        long total;
+
+        static void decode(int key, const Block& block, Entries& out);
+        void store(int key, const Entries& in);
+};
+
+#endif /* COLDSTORE_HPP */
@@ -0,0 +1,142 @@
+#include "IdempotencyCache.hpp"
+#include <algorithm>
+
+static const int SLOTS = 4;
+static const int MAX_KICKS = 500;
+static const uint32_t EMPTY = 0;
+static const uint32_t OK = 1;
+
+static uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t hashOf(uint64_t key) { return mix(key + 0x9E3779B97F4A7C15ULL); }
+
+static uint16_t fingerprintOf(uint64_t hash)
+{
+    uint16_t fp = static_cast<uint16_t>(hash >> 48);
+    return fp ? fp : 1;
+}
+
+IdempotencyCache::IdempotencyCache(int p_windowSeconds, int p_bucketBits, int p_exactBits)
+    : windowSeconds(p_windowSeconds), bucketBits(p_bucketBits), exactBits(p_exactBits),
+      current(0), windowStart(0)
+{
+}
+
+IdempotencyCache::~IdempotencyCache() {}
+
+// Drops the older generation; a window with no traffic at all clears both.
+void IdempotencyCache::rotate(std::time_t now)
+{
+    if (filters[0].empty()) {
+        filters[0].resize(static_cast<std::size_t>(SLOTS) << bucketBits, 0);
+        filters[1].resize(static_cast<std::size_t>(SLOTS) << bucketBits, 0);
+        exact.resize(static_cast<std::size_t>(1) << exactBits, Entry());
+    }
+    else {
+        if (now - windowStart >= 2 * windowSeconds)
+            std::fill(filters[current].begin(), filters[current].end(), 0);
+        current ^= 1;
+        std::fill(filters[current].begin(), filters[current].end(), 0);
+    }
+    windowStart = now;
+}
+
+std::size_t IdempotencyCache::altBucket(std::size_t bucket, uint16_t fingerprint) const
+{
+    return (bucket ^ mix(fingerprint)) & ((static_cast<std::size_t>(1) << bucketBits) - 1);
+}
+
+bool IdempotencyCache::contains(const std::vector<uint16_t>& filter, uint64_t hash) const
+{
+    uint16_t fp = fingerprintOf(hash);
+    std::size_t b1 = hash & ((static_cast<std::size_t>(1) << bucketBits) - 1);
+    const uint16_t *s1 = &filter[b1 * SLOTS];
+    const uint16_t *s2 = &filter[altBucket(b1, fp) * SLOTS];
+
+    return s1[0] == fp || s1[1] == fp || s1[2] == fp || s1[3] == fp
+        || s2[0] == fp || s2[1] == fp || s2[2] == fp || s2[3] == fp;
+}
+
+// On failure bucket and fingerprint hold the entry evicted by the last
+// kick, which still has to be placed somewhere.
+bool IdempotencyCache::insert(std::vector<uint16_t>& filter, std::size_t& bucket, uint16_t& fp)
+{
+    for (int kick = 0; kick < MAX_KICKS; ++kick) {
+        std::size_t other = altBucket(bucket, fp);
+        for (int i = 0; i < SLOTS; ++i) {
+            if (filter[bucket * SLOTS + i] == 0) {
+                filter[bucket * SLOTS + i] = fp;
+                return true;
+            }
+            if (filter[other * SLOTS + i] == 0) {
+                filter[other * SLOTS + i] = fp;
+                return true;
+            }
+        }
+        std::swap(fp, filter[other * SLOTS + kick % SLOTS]);
+        bucket = other;
+    }
+    return false;
+}
+
+uint32_t IdempotencyCache::outcomeOf(const char *error)
+{
+    if (!error)
+        return OK;
+
+    std::map<std::string, uint32_t>::iterator it = errorIndex.find(error);
+    if (it != errorIndex.end())
+        return it->second;
+    errors.push_back(error);
+    uint32_t outcome = static_cast<uint32_t>(errors.size() + 1);
+    errorIndex[error] = outcome;
+    return outcome;
+}
+
+// The filter answers the common case (a fresh key) without touching the
+// exact table. A filter hit whose outcome is no longer in the exact table
+// is either an old key or a fingerprint collision; both are UNKNOWN.
+IdempotencyCache::Status IdempotencyCache::check(uint64_t key, std::time_t now, std::string& error)
+{
+    if (filters[0].empty() || now - windowStart >= windowSeconds)
+        rotate(now);
+
+    uint64_t hash = hashOf(key);
+    if (!contains(filters[current], hash) && !contains(filters[current ^ 1], hash))
+        return NEW;
+
+    const Entry& entry = exact[hash & (exact.size() - 1)];
+    if (entry.outcome == EMPTY || entry.key != key)
+        return UNKNOWN;
+    if (entry.outcome == OK)
+        return APPLIED;
+    error = errors[entry.outcome - 2];
+    return FAILED;
+}
+
+// A full filter rotates early: the previous window is dropped, and the
+// fingerprint left over by the failed insert goes into the fresh one, so
+// no key of the current window is lost.
+void IdempotencyCache::record(uint64_t key, std::time_t now, const char *error)
+{
+    if (filters[0].empty())
+        rotate(now);
+
+    uint64_t hash = hashOf(key);
+    std::size_t bucket = hash & ((static_cast<std::size_t>(1) << bucketBits) - 1);
+    uint16_t fp = fingerprintOf(hash);
+
+    if (!insert(filters[current], bucket, fp)) {
+        rotate(now);
+        insert(filters[current], bucket, fp);
+    }
+
+    Entry& entry = exact[hash & (exact.size() - 1)];
+    entry.key = key;
+    entry.outcome = outcomeOf(error);
+}
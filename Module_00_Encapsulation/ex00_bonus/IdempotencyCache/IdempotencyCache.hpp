@@ -0,0 +1,62 @@
+#ifndef IDEMPOTENCYCACHE_HPP
+#define IDEMPOTENCYCACHE_HPP
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Fixed-memory record of recently seen request keys. Two cuckoo filters
+// (16-bit fingerprints, 4 per bucket) cover the current and the previous
+// time window, so a key is remembered for one to two windows. A small
+// direct-mapped table keeps the exact outcome of the most recent keys.
+// A key the filters have seen but whose outcome is no longer in the table
+// is UNKNOWN. A window that fills its filter rotates early. Nothing is
+// allocated until the first key is checked.
+class IdempotencyCache
+{
+    public:
+        enum Status
+        {
+            NEW,
+            APPLIED,
+            FAILED,
+            UNKNOWN
+        };
+
+        IdempotencyCache(int p_windowSeconds = 60, int p_bucketBits = 19, int p_exactBits = 18);
+        ~IdempotencyCache();
+
+        Status check(uint64_t key, std::time_t now, std::string& error);
+        void record(uint64_t key, std::time_t now, const char *error);
+
+    private:
+        // outcome 0 is an empty slot, 1 applied, n >= 2 failed with errors[n - 2]
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t outcome;
+        };
+
+        int windowSeconds;
+        int bucketBits;
+        int exactBits;
+
+        std::vector<uint16_t> filters[2];
+        int current;
+        std::time_t windowStart;
+        std::vector<Entry> exact;
+
+        // failure messages are interned, entries only keep an index
+        std::vector<std::string> errors;
+        std::map<std::string, uint32_t> errorIndex;
+
+        void rotate(std::time_t now);
+        bool contains(const std::vector<uint16_t>& filter, uint64_t hash) const;
+        bool insert(std::vector<uint16_t>& filter, std::size_t& bucket, uint16_t& fingerprint);
+        std::size_t altBucket(std::size_t bucket, uint16_t fingerprint) const;
+        uint32_t outcomeOf(const char *error);
+};
+
+#endif /* IDEMPOTENCYCACHE_HPP */
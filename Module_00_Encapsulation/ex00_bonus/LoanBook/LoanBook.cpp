@@ -0,0 +1,102 @@
+#include "LoanBook.hpp"
+
+LoanBook::LoanBook() : outstanding(0) {}
+
+LoanBook::~LoanBook() {}
+
+std::size_t LoanBook::addBorrower()
+{
+    if (!freeSlots.empty()) {
+        std::size_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        exposure[slot] = 0;
+        return slot;
+    }
+    exposure.push_back(0);
+    return exposure.size() - 1;
+}
+
+// Only for a borrower with no exposure left: no open loan points at it.
+void LoanBook::releaseBorrower(std::size_t p_borrower)
+{
+    freeSlots.push_back(p_borrower);
+}
+
+void LoanBook::open(std::size_t p_borrower, int principal, int p_rateBps, int terms)
+{
+    borrower.push_back(p_borrower);
+    principalLeft.push_back(principal);
+    rateBps.push_back(p_rateBps);
+    termsLeft.push_back(terms);
+    exposure[p_borrower] += principal;
+    outstanding += principal;
+}
+
+// One period of simple interest on every open loan. The first loop only
+// touches the dense columns; the scatter into per-borrower exposure is
+// kept apart so it does not block vectorization of the arithmetic.
+long LoanBook::accrueInterest()
+{
+    std::size_t count = principalLeft.size();
+    long total = 0;
+
+    scratch.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        scratch[i] = principalLeft[i] * rateBps[i] / 10000;
+        principalLeft[i] += scratch[i];
+        total += scratch[i];
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        exposure[borrower[i]] += scratch[i];
+    outstanding += total;
+    return total;
+}
+
+// Equal-principal schedule: each loan owes its balance spread over the
+// remaining terms, rounded up so the last term clears it.
+long LoanBook::scheduleInstallments(std::vector<long>& due) const
+{
+    std::size_t count = principalLeft.size();
+    long total = 0;
+
+    due.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        due[i] = (principalLeft[i] + termsLeft[i] - 1) / termsLeft[i];
+        total += due[i];
+    }
+    return total;
+}
+
+void LoanBook::applyRepayment(std::size_t loan, long amount)
+{
+    principalLeft[loan] -= amount;
+    exposure[borrower[loan]] -= amount;
+    outstanding -= amount;
+    if (termsLeft[loan] > 1)
+        termsLeft[loan]--;
+}
+
+// Drops fully repaid rows by moving the last row into their place.
+void LoanBook::settle()
+{
+    std::size_t i = 0;
+    while (i < principalLeft.size()) {
+        if (principalLeft[i] > 0) {
+            ++i;
+            continue;
+        }
+        borrower[i] = borrower.back();
+        principalLeft[i] = principalLeft.back();
+        rateBps[i] = rateBps.back();
+        termsLeft[i] = termsLeft.back();
+        borrower.pop_back();
+        principalLeft.pop_back();
+        rateBps.pop_back();
+        termsLeft.pop_back();
+    }
+}
+
+const long& LoanBook::get_exposure(std::size_t p_borrower) const { return exposure[p_borrower]; }
+const long& LoanBook::get_outstanding() const { return outstanding; }
+const std::size_t& LoanBook::get_borrower(std::size_t loan) const { return borrower[loan]; }
+std::size_t LoanBook::get_loanCount() const { return principalLeft.size(); }
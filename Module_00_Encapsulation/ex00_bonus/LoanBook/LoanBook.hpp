@@ -0,0 +1,46 @@
+#ifndef LOANBOOK_HPP
+#define LOANBOOK_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Dense loan table kept as parallel arrays (one row per loan) so that
+// interest accrual and installment scheduling are single linear passes
+// the compiler can vectorize. Exposure is aggregated per borrower slot,
+// which makes the per-account lookup O(1).
+class LoanBook
+{
+    public:
+        LoanBook();
+        ~LoanBook();
+
+        std::size_t addBorrower();
+        void releaseBorrower(std::size_t borrower);
+        void open(std::size_t borrower, int principal, int rateBps, int terms);
+
+        long accrueInterest();
+        long scheduleInstallments(std::vector<long>& due) const;
+        void applyRepayment(std::size_t loan, long amount);
+        void settle();
+
+        const long& get_exposure(std::size_t borrower) const;
+        const long& get_outstanding() const;
+        const std::size_t& get_borrower(std::size_t loan) const;
+        std::size_t get_loanCount() const;
+
+    private:
+        // one row per open loan
+        std::vector<std::size_t> borrower;
+        std::vector<long> principalLeft;
+        std::vector<int> rateBps;
+        std::vector<int> termsLeft;
+
+        // one row per borrower slot; released slots are reused
+        std::vector<long> exposure;
+        std::vector<std::size_t> freeSlots;
+
+        std::vector<long> scratch;
+        long outstanding;
+};
+
+#endif /* LOANBOOK_HPP */
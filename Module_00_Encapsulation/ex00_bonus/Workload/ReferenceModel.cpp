@@ -0,0 +1,147 @@
+#include "ReferenceModel.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+static std::string format_cents(long cents)
+{
+    long abs_cents = cents < 0 ? -cents : cents;
+    long dollars = abs_cents / 100;
+    long rem = abs_cents % 100;
+    std::ostringstream oss;
+
+    if (cents < 0)
+        oss << "-";
+    oss << "$" << dollars << "." << std::setw(2) << std::setfill('0') << rem;
+    return oss.str();
+}
+
+// Inverse of format_cents, for lines of a dump: "-$12.05" is -1205.
+static long parse_cents(const std::string& text)
+{
+    long cents = 0;
+
+    for (std::string::size_type i = 0; i < text.size(); ++i) {
+        if (text[i] >= '0' && text[i] <= '9')
+            cents = cents * 10 + (text[i] - '0');
+    }
+    return text.find('-') == std::string::npos ? cents : -cents;
+}
+
+ReferenceModel::ReferenceModel(long p_liquidity)
+    : liquidity(p_liquidity), outstanding(0), expectedTotal(p_liquidity)
+{
+}
+
+ReferenceModel::~ReferenceModel() {}
+
+// Mirrors the order of the checks in Bank, which only matters for which
+// error is reported, never for whether the op succeeds.
+bool ReferenceModel::apply(const Operation& op)
+{
+    std::map<int, long>::iterator account = balances.find(op.id);
+    long fee = op.amount * 5L / 100;
+
+    switch (op.type) {
+        case OP_CREATE:
+            if (op.amount <= 0 || account != balances.end())
+                return false;
+            liquidity += fee;
+            balances[op.id] = op.amount - fee;
+            expectedTotal += op.amount;
+            return true;
+        case OP_REMOVE:
+            if (account == balances.end() || exposure[op.id] > 0)
+                return false;
+            expectedTotal -= account->second;
+            balances.erase(account);
+            return true;
+        case OP_DEPOSIT:
+            if (op.amount <= 0 || account == balances.end())
+                return false;
+            liquidity += fee;
+            account->second += op.amount - fee;
+            expectedTotal += op.amount;
+            return true;
+        case OP_WITHDRAW:
+            if (op.amount <= 0 || account == balances.end() || account->second < op.amount)
+                return false;
+            account->second -= op.amount;
+            expectedTotal -= op.amount;
+            return true;
+        case OP_LOAN:
+            if (op.amount <= 0 || liquidity < op.amount || account == balances.end())
+                return false;
+            liquidity -= op.amount;
+            account->second += op.amount;
+            exposure[op.id] += op.amount;
+            outstanding += op.amount;
+            return true;
+    }
+    return false;
+}
+
+// Expected lines of operator<<(Bank), sorted like the workload digest.
+void ReferenceModel::render(std::vector<std::string>& lines) const
+{
+    lines.clear();
+    lines.push_back("Bank informations : ");
+    lines.push_back("Liquidity : " + format_cents(liquidity));
+    lines.push_back("Outstanding loans : " + format_cents(outstanding));
+    for (std::map<int, long>::const_iterator it = balances.begin(); it != balances.end(); ++it) {
+        std::ostringstream oss;
+        oss << "[" << it->first << "] - [" << format_cents(it->second) << "]";
+        lines.push_back(oss.str());
+    }
+    std::sort(lines.begin(), lines.end());
+}
+
+// Money is only created by inflows and destroyed by withdrawals and
+// removals; loans and fees move it between the bank and its clients.
+std::string ReferenceModel::invariantError() const
+{
+    long total = liquidity;
+
+    for (std::map<int, long>::const_iterator it = balances.begin(); it != balances.end(); ++it) {
+        if (it->second < 0)
+            return "negative balance";
+        total += it->second;
+    }
+    if (total != expectedTotal)
+        return "money not conserved";
+    if (liquidity < 0)
+        return "negative liquidity";
+    return "";
+}
+
+// The same invariants, read off a dump of the Bank rather than the model:
+// the model satisfies them by construction, the Bank has to be checked.
+std::string ReferenceModel::invariantError(const std::vector<std::string>& dump) const
+{
+    static const std::string LIQUIDITY = "Liquidity : ";
+    long total = 0;
+    bool sawLiquidity = false;
+
+    for (std::vector<std::string>::const_iterator it = dump.begin(); it != dump.end(); ++it) {
+        long cents;
+        if (it->compare(0, LIQUIDITY.size(), LIQUIDITY) == 0) {
+            cents = parse_cents(it->substr(LIQUIDITY.size()));
+            if (cents < 0)
+                return "negative liquidity";
+            sawLiquidity = true;
+        }
+        else if (!it->empty() && (*it)[0] == '[') {
+            cents = parse_cents(it->substr(it->find("] - [") + 5));
+            if (cents < 0)
+                return "negative balance";
+        }
+        else
+            continue;
+        total += cents;
+    }
+    if (!sawLiquidity)
+        return "no liquidity line";
+    if (total != expectedTotal)
+        return "money not conserved";
+    return "";
+}
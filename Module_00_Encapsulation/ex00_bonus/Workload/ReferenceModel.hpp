@@ -0,0 +1,32 @@
+#ifndef REFERENCEMODEL_HPP
+#define REFERENCEMODEL_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Workload.hpp"
+
+// Deliberately naive model of the Bank rules (std::map, no tiering, no
+// split balances, no caches). `./workload check` runs it next to the real
+// Bank and expects the same outcome for every op and the same dump.
+class ReferenceModel
+{
+    public:
+        ReferenceModel(long p_liquidity);
+        ~ReferenceModel();
+
+        bool apply(const Operation& op);
+        void render(std::vector<std::string>& lines) const;
+        std::string invariantError() const;
+        std::string invariantError(const std::vector<std::string>& dump) const;
+
+    private:
+        long liquidity;
+        long outstanding;
+        long expectedTotal;
+        std::map<int, long> balances;
+        std::map<int, long> exposure;
+};
+
+#endif /* REFERENCEMODEL_HPP */
@@ -51,6 +51,25 @@ int main()
 		std::cerr << "Error: " << e.what() << std::endl;
 	}
 
+	std::cout << "\n=== Retried Requests (idempotency keys) ===" << std::endl;
+
+	try {
+		bank.depositToAccount(0, 500, 42);
+		bank.depositToAccount(0, 500, 42);
+		std::cout << "Retried deposit applied once" << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		try {
+			bank.withdrawFromAccount(1, 900000, 43);
+			std::cout << "ERROR: Withdraw should have failed (insufficient balance)" << std::endl;
+		} catch (const std::exception& e) {
+			std::cout << "Expected error (attempt " << attempt + 1 << "): " << e.what() << std::endl;
+		}
+	}
+
 	std::cout << "\n=== Withdraw from Account B ===" << std::endl;
 	
 	try {
@@ -83,6 +102,60 @@ int main()
 		std::cout << "Expected error: " << e.what() << std::endl;
 	}
 
+	std::cout << "\n=== Loan Book ===" << std::endl;
+
+	try {
+		bank.giveLoan(0, 1000, 150, 4);
+		bank.accrueLoanInterest();
+		bank.collectLoanInstallments();
+		std::cout << "Account A exposure: " << format_cents(bank.get_exposure(0)) << std::endl;
+		std::cout << "Outstanding loans: " << format_cents(bank.get_outstandingLoans()) << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	try {
+		bank.giveLoan(0, 100, -1, 4);
+		std::cout << "ERROR: Loan should have failed (negative rate)" << std::endl;
+	} catch (const std::exception& e) {
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+
+	std::cout << "\n=== Multi-Currency Accounts ===" << std::endl;
+
+	try {
+		bank.createAccount(2, 5000, "EUR");
+		bank.depositToAccount(2, 1000);
+		bank.printConsolidation(std::cout);
+
+		std::map<std::string, long> rates;
+		rates["EUR"] = 1100000;
+		bank.swapRates(rates);
+		std::cout << "After EUR rate update: " << format_cents(bank.consolidatedTotal()) << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	try {
+		bank.giveLoan(2, 100);
+		std::cout << "ERROR: Loan should have failed (non-base currency)" << std::endl;
+	} catch (const std::exception& e) {
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+
+	std::cout << "\n=== Loan Rate Limits ===" << std::endl;
+
+	try {
+		bank.set_loanRateLimit(2, 100);
+		bank.giveLoan(0, 50);
+		bank.giveLoan(0, 50);
+		bank.giveLoan(0, 50);
+		std::cout << "ERROR: Third loan should have been rate limited" << std::endl;
+	} catch (const std::exception& e) {
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+	bank.set_loanRateLimit(0, 0);
+
 	std::cout << "\n=== Current State ===" << std::endl;
 	try {
 		std::cout << "Account A: ";
@@ -0,0 +1,246 @@
+#include "Bank/Bank.hpp"
+#include "Workload/Workload.hpp"
+#include "Workload/ReferenceModel.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <streambuf>
+
+// Swallows Bank's per-operation logging while a workload is being driven.
+class NullBuffer : public std::streambuf
+{
+	protected:
+		int overflow(int c) { return c; }
+};
+
+static void usage()
+{
+	std::cerr << "usage: ./workload run    [key=value ...]" << std::endl
+	          << "       ./workload record <trace> [key=value ...]" << std::endl
+	          << "       ./workload replay <trace> [liquidity=N]" << std::endl
+	          << "       ./workload check  [<trace>] [key=value ...]" << std::endl
+	          << "options: seed accounts ops skew decline max mix=c,r,d,w,l liquidity cold" << std::endl
+	          << "check:   rounds (seeds seed..seed+rounds-1) verify (ops between full dump checks)" << std::endl;
+}
+
+static bool apply(Bank& bank, const Operation& op)
+{
+	try {
+		switch (op.type) {
+			case OP_CREATE:   bank.createAccount(op.id, op.amount); break;
+			case OP_REMOVE:   bank.removeAccount(op.id); break;
+			case OP_DEPOSIT:  bank.depositToAccount(op.id, op.amount); break;
+			case OP_WITHDRAW: bank.withdrawFromAccount(op.id, op.amount); break;
+			case OP_LOAN:     bank.giveLoan(op.id, op.amount); break;
+		}
+	} catch (const std::exception&) {
+		return false;
+	}
+	return true;
+}
+
+// The bank's own dump as sorted lines: the order in which accounts are
+// listed depends on cold tiering, not on their state.
+static void dumpLines(const Bank& bank, std::vector<std::string>& lines)
+{
+	std::ostringstream oss;
+	oss << bank;
+
+	std::istringstream dump(oss.str());
+	std::string line;
+	lines.clear();
+	while (std::getline(dump, line)) {
+		if (!line.empty())
+			lines.push_back(line);
+	}
+	std::sort(lines.begin(), lines.end());
+}
+
+// FNV-1a over the sorted dump, so two builds can be compared without
+// exposing any internals.
+static uint64_t digest(const Bank& bank)
+{
+	std::vector<std::string> lines;
+	dumpLines(bank, lines);
+
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+		for (std::string::size_type i = 0; i < it->size(); ++i) {
+			hash ^= static_cast<unsigned char>((*it)[i]);
+			hash *= 0x100000001B3ULL;
+		}
+		hash ^= '\n';
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static void drive(const std::vector<Operation>& ops, int liquidity, unsigned long coldAfter)
+{
+	NullBuffer null;
+	std::streambuf *saved = std::cout.rdbuf(&null);
+	long declined = 0;
+	uint64_t hash;
+	int finalLiquidity;
+	std::size_t coldAccounts;
+	std::clock_t start = std::clock();
+	{
+		Bank bank(liquidity);
+		bank.set_coldAfter(coldAfter);
+		for (std::vector<Operation>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+			if (!apply(bank, *it))
+				++declined;
+		}
+		hash = digest(bank);
+		finalLiquidity = bank.get_liquidity();
+		coldAccounts = bank.get_coldAccountCount();
+	}
+	double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+	std::cout.rdbuf(saved);
+
+	std::cout << "operations : " << ops.size() << std::endl
+	          << "declined   : " << declined << std::endl
+	          << "seconds    : " << seconds << std::endl
+	          << "ops/sec    : " << (seconds > 0 ? static_cast<long>(ops.size() / seconds) : 0) << std::endl
+	          << "liquidity  : " << finalLiquidity << std::endl
+	          << "cold accts : " << coldAccounts << std::endl
+	          << "state hash : " << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::endl;
+}
+
+static std::string duplicateId(const std::vector<std::string>& lines)
+{
+	std::vector<std::string> ids;
+	for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
+		if (!it->empty() && (*it)[0] == '[')
+			ids.push_back(it->substr(0, it->find(']') + 1));
+	}
+	std::sort(ids.begin(), ids.end());
+	std::vector<std::string>::iterator dup = std::adjacent_find(ids.begin(), ids.end());
+	return dup == ids.end() ? "" : *dup;
+}
+
+// Runs the ops on the Bank and on the reference model side by side. Every
+// op must succeed or fail on both, and every `verify` ops the full dump,
+// money conservation, non-negative balances and id uniqueness are checked,
+// the invariants on the bank's own dump as well as on the model.
+static bool check(const std::vector<Operation>& ops, int liquidity, unsigned long coldAfter, long verify)
+{
+	NullBuffer null;
+	std::streambuf *saved = std::cout.rdbuf(&null);
+	std::ostringstream failure;
+	{
+		Bank bank(liquidity);
+		ReferenceModel model(liquidity);
+		std::vector<std::string> actual;
+		std::vector<std::string> expected;
+
+		bank.set_coldAfter(coldAfter);
+		for (std::size_t i = 0; i < ops.size() && failure.str().empty(); ++i) {
+			const Operation& op = ops[i];
+			bool ok = apply(bank, op);
+			if (ok != model.apply(op)) {
+				failure << "op " << i << " (type " << static_cast<int>(op.type) << ", id " << op.id
+				        << ", amount " << op.amount << ") " << (ok ? "succeeded" : "failed")
+				        << " on the bank only";
+				break;
+			}
+			if ((verify > 0 && (i + 1) % verify == 0) || i + 1 == ops.size()) {
+				std::string invariant = model.invariantError();
+				dumpLines(bank, actual);
+				model.render(expected);
+				if (!invariant.empty())
+					failure << "after op " << i << ": model " << invariant;
+				else if (!(invariant = model.invariantError(actual)).empty())
+					failure << "after op " << i << ": bank " << invariant;
+				else if (!duplicateId(actual).empty())
+					failure << "after op " << i << ": duplicate id " << duplicateId(actual);
+				else if (actual != expected)
+					failure << "after op " << i << ": bank dump differs from the model";
+			}
+		}
+	}
+	std::cout.rdbuf(saved);
+
+	if (!failure.str().empty()) {
+		std::cout << "check failed: " << failure.str() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		usage();
+		return (1);
+	}
+
+	std::string mode = argv[1];
+	std::string trace = (argc > 2 && std::strchr(argv[2], '=') == NULL) ? argv[2] : "";
+	int first = (mode == "run" || (mode == "check" && trace.empty())) ? 2 : 3;
+	if ((mode != "run" && mode != "record" && mode != "replay" && mode != "check") || argc < first) {
+		usage();
+		return (1);
+	}
+
+	try {
+		WorkloadConfig config;
+		int liquidity = 100000000;
+		unsigned long coldAfter = 0;
+		long rounds = 1;
+		long verify = 10000;
+		std::vector<Operation> ops;
+
+		for (int i = first; i < argc; ++i) {
+			if (std::strncmp(argv[i], "liquidity=", 10) == 0)
+				liquidity = std::atoi(argv[i] + 10);
+			else if (std::strncmp(argv[i], "cold=", 5) == 0)
+				coldAfter = std::strtoul(argv[i] + 5, NULL, 10);
+			else if (std::strncmp(argv[i], "rounds=", 7) == 0)
+				rounds = std::atol(argv[i] + 7);
+			else if (std::strncmp(argv[i], "verify=", 7) == 0)
+				verify = std::atol(argv[i] + 7);
+			else
+				config.set(argv[i]);
+		}
+
+		if (mode == "check") {
+			std::clock_t start = std::clock();
+			long total = 0;
+			for (long round = 0; round < (trace.empty() ? rounds : 1); ++round) {
+				if (trace.empty()) {
+					WorkloadConfig seeded = config;
+					seeded.seed = config.seed + round;
+					Workload(seeded).generate(ops);
+				}
+				else
+					Workload::load(trace, ops);
+				if (!check(ops, liquidity, coldAfter, verify)) {
+					if (trace.empty())
+						std::cout << "failing seed: " << config.seed + round << " (rerun with the same options and seed=" << config.seed + round << ")" << std::endl;
+					return (1);
+				}
+				total += ops.size();
+			}
+			std::cout << "check passed: " << total << " ops in "
+			          << static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC << " s" << std::endl;
+			return (0);
+		}
+		if (mode == "replay")
+			Workload::load(argv[2], ops);
+		else {
+			Workload workload(config);
+			workload.generate(ops);
+			if (mode == "record")
+				Workload::save(argv[2], ops);
+		}
+		drive(ops, liquidity, coldAfter);
+	} catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return (1);
+	}
+	return (0);
+}